@@ -0,0 +1,70 @@
+import argparse
+import csv
+from pathlib import Path
+
+# Combine the per-flavor CSVs written by infrastructure/build/flavor_matrix.cmake
+# into one table: every kernel's mean time in the baseline flavor and its
+# ratio in every other flavor (1.25 = 25% slower than the plain Release build).
+
+def load_lab_csv(path):
+    # Lab stdout is a banner line, the CSV block, then optional extra blocks
+    # (e.g. --roofline) after a blank line. Only the first block is results.
+    rows = []
+    header = None
+    with open(path, newline="") as f:
+        for line in f:
+            line = line.rstrip("\r\n")
+            if header is None:
+                if line.startswith("name,"):
+                    header = next(csv.reader([line]))
+                continue
+            if not line:
+                break
+            rows.append(dict(zip(header, next(csv.reader([line])))))
+    return rows
+
+def load_flavor(folder):
+    out = {}
+    for p in sorted(Path(folder).glob("*.csv")):
+        for r in load_lab_csv(p):
+            out[(p.stem, r["name"])] = float(r["mean_ns"])
+    return out
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--matrix", required=True, help="results root containing one folder per flavor")
+    ap.add_argument("--baseline", default="release")
+    ap.add_argument("--flavors", nargs="*", help="flavors to include (default: every folder)")
+    ap.add_argument("--csv", help="write the combined report here")
+    args = ap.parse_args()
+
+    root = Path(args.matrix)
+    flavors = args.flavors or sorted(p.name for p in root.iterdir() if p.is_dir() and not p.name.startswith("."))
+    if args.baseline not in flavors:
+        raise SystemExit(f"baseline '{args.baseline}' has no results in {root}")
+    others = [f for f in flavors if f != args.baseline]
+
+    data = {f: load_flavor(root / f) for f in flavors}
+    base = data[args.baseline]
+
+    header = ["lab", "kernel", f"{args.baseline}_mean_ns"] + [f"{f}_x" for f in others]
+    rows = []
+    for (lab, kernel), ns in sorted(base.items()):
+        row = [lab, kernel, f"{ns:.0f}"]
+        for f in others:
+            v = data[f].get((lab, kernel))
+            row.append(f"{v / ns:.3f}" if v is not None and ns > 0 else "")
+        rows.append(row)
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            w = csv.writer(f)
+            w.writerow(header)
+            w.writerows(rows)
+
+    widths = [max(len(str(c)) for c in col) for col in zip(header, *rows)]
+    for r in [header] + rows:
+        print("  ".join(str(c).ljust(w) if i < 2 else str(c).rjust(w) for i, (c, w) in enumerate(zip(r, widths))))
+
+if __name__ == "__main__":
+    main()
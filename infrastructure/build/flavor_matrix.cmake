@@ -0,0 +1,133 @@
+# Build every lab in every flavor, run the benchmarks, and write a combined
+# overhead report relative to the plain Release baseline.
+#
+#   cmake -P infrastructure/build/flavor_matrix.cmake
+#   cmake -DFLAVORS="release;hardened;asan" -DOUT=out/matrix -P infrastructure/build/flavor_matrix.cmake
+#
+# Inputs (all optional):
+#   FLAVORS     flavors to run, "release" first (the baseline). "pgo" expands to
+#               an instrumented build + training run + profile-guided rebuild.
+#   OUT         results root: OUT/<flavor>/<lab>.csv, OUT/overhead_report.csv
+#   BUILD_ROOT  build trees: BUILD_ROOT/<flavor>
+#   GENERATOR   forwarded to cmake -G
+#
+# Flavors are defined in flavors.cmake. Ones the compiler cannot express are
+# skipped and left out of the report.
+
+cmake_minimum_required(VERSION 3.20)
+
+get_filename_component(SRC "${CMAKE_CURRENT_LIST_DIR}/../.." ABSOLUTE)
+
+if (NOT FLAVORS)
+  set(FLAVORS release o2 native lto pgo hardened asan ubsan)
+endif()
+if (NOT OUT)
+  set(OUT "${SRC}/out/matrix")
+endif()
+if (NOT BUILD_ROOT)
+  set(BUILD_ROOT "${SRC}/build-matrix")
+endif()
+get_filename_component(OUT "${OUT}" ABSOLUTE)
+get_filename_component(BUILD_ROOT "${BUILD_ROOT}" ABSOLUTE)
+
+# <executable>|<arguments>. Sizes are smaller than the lab defaults so the
+# sanitizer flavors finish in reasonable time; every flavor runs the same list.
+set(RUNS
+  "vs_mem_allocation|200000 10"
+  "vs_mem_layout|2000000 10"
+  "vs_mem_access|8000000 8 16 12345"
+  "vs_mem_access_coro|1048576 1048576 3 12345"
+  "vs_mem_access_spec|16777216 5 16 12345"
+)
+
+set(_gen_args)
+if (GENERATOR)
+  set(_gen_args -G "${GENERATOR}")
+endif()
+
+set(_exe_suffix "")
+if (CMAKE_HOST_WIN32)
+  set(_exe_suffix ".exe")
+endif()
+
+function(vs_configure_and_build dir flavor ok_var)
+  execute_process(
+    COMMAND ${CMAKE_COMMAND} -S "${SRC}" -B "${dir}" ${_gen_args}
+            -DCMAKE_BUILD_TYPE=Release -DVS_FLAVOR=${flavor} -DVS_PGO_DIR=${dir}/pgo-profiles
+    RESULT_VARIABLE rc)
+  if (rc EQUAL 0)
+    execute_process(COMMAND ${CMAKE_COMMAND} --build "${dir}" --config Release --parallel
+                    RESULT_VARIABLE rc)
+  endif()
+  if (rc EQUAL 0)
+    set(${ok_var} ON PARENT_SCOPE)
+  else()
+    set(${ok_var} OFF PARENT_SCOPE)
+  endif()
+endfunction()
+
+# Runs every entry in RUNS from build dir `dir`, CSV to `results`/<exe>.csv.
+function(vs_run_labs dir results)
+  file(MAKE_DIRECTORY "${results}")
+  foreach(run IN LISTS RUNS)
+    string(FIND "${run}" "|" bar)
+    string(SUBSTRING "${run}" 0 ${bar} exe)
+    math(EXPR args_at "${bar} + 1")
+    string(SUBSTRING "${run}" ${args_at} -1 args)
+    separate_arguments(args)
+
+    # Multi-config generators (Visual Studio) add a per-config directory.
+    set(path "${dir}/labs/memory/Release/${exe}${_exe_suffix}")
+    if (NOT EXISTS "${path}")
+      set(path "${dir}/labs/memory/${exe}${_exe_suffix}")
+    endif()
+    if (NOT EXISTS "${path}")
+      message(WARNING "${exe} not built in ${dir}")
+      continue()
+    endif()
+
+    message(STATUS "  ${exe} ${args}")
+    execute_process(COMMAND "${path}" ${args}
+                    OUTPUT_FILE "${results}/${exe}.csv"
+                    ERROR_FILE "${results}/${exe}.log"
+                    RESULT_VARIABLE rc)
+    if (NOT rc EQUAL 0)
+      message(WARNING "${exe} exited with ${rc} (see ${results}/${exe}.log)")
+    endif()
+  endforeach()
+endfunction()
+
+set(done)
+foreach(flavor IN LISTS FLAVORS)
+  message(STATUS "=== flavor: ${flavor}")
+  set(dir "${BUILD_ROOT}/${flavor}")
+
+  if (flavor STREQUAL "pgo")
+    # Both phases share one build dir: GCC keys profiles by object path.
+    vs_configure_and_build("${dir}" pgo-gen ok)
+    if (ok)
+      file(REMOVE_RECURSE "${dir}/pgo-profiles")
+      vs_run_labs("${dir}" "${OUT}/.pgo-training")
+      vs_configure_and_build("${dir}" pgo-use ok)
+    endif()
+  else()
+    vs_configure_and_build("${dir}" ${flavor} ok)
+  endif()
+
+  if (NOT ok)
+    message(WARNING "flavor ${flavor} skipped (configure or build failed)")
+    continue()
+  endif()
+  vs_run_labs("${dir}" "${OUT}/${flavor}")
+  list(APPEND done ${flavor})
+endforeach()
+
+list(GET FLAVORS 0 baseline)
+find_program(PYTHON NAMES python3 python)
+if (PYTHON AND done)
+  execute_process(COMMAND ${PYTHON} "${SRC}/infrastructure/benchmarking/overhead_report.py"
+                          --matrix "${OUT}" --baseline ${baseline} --flavors ${done}
+                          --csv "${OUT}/overhead_report.csv")
+else()
+  message(STATUS "Results in ${OUT}; run infrastructure/benchmarking/overhead_report.py for the report")
+endif()
@@ -0,0 +1,127 @@
+# Build flavors for the overhead matrix (infrastructure/build/flavor_matrix.cmake).
+#
+#   cmake -S . -B build-asan -DCMAKE_BUILD_TYPE=Release -DVS_FLAVOR=asan
+#
+# Every flavor is a Release build plus the flags below, so the only variable
+# between two result folders is the flavor itself. An empty VS_FLAVOR (the
+# default) and "release" leave the build untouched: that is the baseline, the
+# same -O3 (GCC/Clang) or /O2 (MSVC) build users run, and every add-on flavor
+# is priced on top of it.
+#
+# Because Release already means -O3 on GCC/Clang there is no o3 flavor; the
+# optimisation-level variant goes the other way instead:
+#
+#   o2          -O2 in place of Release's -O3 (GCC/Clang only; MSVC Release
+#               is already /O2, so it would repeat the baseline)
+#   native      -march=native (MSVC: /arch:AVX2)
+#   lto         CMAKE_INTERPROCEDURAL_OPTIMIZATION
+#   pgo-gen     instrumented build; run the labs to write profiles to VS_PGO_DIR
+#   pgo-use     rebuild the *same* build dir with those profiles
+#   hardened    the production set: _GLIBCXX_ASSERTIONS, _FORTIFY_SOURCE,
+#               -fstack-protector-strong (MSVC: /GS /sdl)
+#   asan        AddressSanitizer
+#   ubsan       UndefinedBehaviorSanitizer
+#
+# A flavor the current compiler cannot express stops configuration with an
+# error; the matrix driver records it as skipped.
+
+set(VS_FLAVOR "" CACHE STRING "Build flavor for the overhead matrix (see infrastructure/build/flavors.cmake)")
+set(VS_PGO_DIR "${CMAKE_BINARY_DIR}/pgo-profiles" CACHE PATH "Profile directory shared by pgo-gen and pgo-use")
+
+set(_vs_gnu_like OFF)
+if (CMAKE_CXX_COMPILER_ID MATCHES "GNU|Clang")
+  set(_vs_gnu_like ON)
+endif()
+
+function(vs_flavor_unsupported flavor)
+  message(FATAL_ERROR "VS_FLAVOR=${flavor} is not supported with ${CMAKE_CXX_COMPILER_ID}")
+endfunction()
+
+# Replaces the optimisation level in the Release flags (rather than appending
+# a second one) so the compile line shows exactly one.
+macro(vs_set_release_opt level)
+  string(REGEX REPLACE "-O[0-9sz]?( |$)" "" CMAKE_CXX_FLAGS_RELEASE "${CMAKE_CXX_FLAGS_RELEASE}")
+  string(APPEND CMAKE_CXX_FLAGS_RELEASE " -${level}")
+endmacro()
+
+if (VS_FLAVOR STREQUAL "" OR VS_FLAVOR STREQUAL "release")
+  # baseline
+
+elseif (VS_FLAVOR STREQUAL "o2")
+  if (NOT _vs_gnu_like)
+    vs_flavor_unsupported(o2)
+  endif()
+  vs_set_release_opt(O2)
+
+elseif (VS_FLAVOR STREQUAL "native")
+  if (MSVC)
+    add_compile_options(/arch:AVX2)
+  else()
+    add_compile_options(-march=native)
+  endif()
+
+elseif (VS_FLAVOR STREQUAL "lto")
+  include(CheckIPOSupported)
+  check_ipo_supported(RESULT _vs_ipo OUTPUT _vs_ipo_msg)
+  if (NOT _vs_ipo)
+    message(FATAL_ERROR "VS_FLAVOR=lto: ${_vs_ipo_msg}")
+  endif()
+  set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)
+
+elseif (VS_FLAVOR STREQUAL "pgo-gen")
+  if (NOT _vs_gnu_like)
+    vs_flavor_unsupported(pgo-gen)
+  endif()
+  file(MAKE_DIRECTORY "${VS_PGO_DIR}")
+  add_compile_options(-fprofile-generate=${VS_PGO_DIR})
+  add_link_options(-fprofile-generate=${VS_PGO_DIR})
+
+elseif (VS_FLAVOR STREQUAL "pgo-use")
+  if (NOT _vs_gnu_like)
+    vs_flavor_unsupported(pgo-use)
+  endif()
+  if (CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    # Clang writes raw profiles; merge them before they can be used.
+    find_program(VS_LLVM_PROFDATA NAMES llvm-profdata REQUIRED)
+    file(GLOB _vs_profraw "${VS_PGO_DIR}/*.profraw")
+    execute_process(COMMAND ${VS_LLVM_PROFDATA} merge -output=${VS_PGO_DIR}/default.profdata ${_vs_profraw}
+                    RESULT_VARIABLE _vs_merge)
+    if (NOT _vs_merge EQUAL 0)
+      message(FATAL_ERROR "VS_FLAVOR=pgo-use: llvm-profdata merge failed")
+    endif()
+    add_compile_options(-fprofile-use=${VS_PGO_DIR}/default.profdata)
+  else()
+    add_compile_options(-fprofile-use=${VS_PGO_DIR} -fprofile-correction -Wno-missing-profile)
+  endif()
+
+elseif (VS_FLAVOR STREQUAL "hardened")
+  if (MSVC)
+    add_compile_options(/GS /sdl)
+  else()
+    # Some toolchains predefine _FORTIFY_SOURCE; reset it so the level is ours.
+    add_compile_definitions(_GLIBCXX_ASSERTIONS)
+    add_compile_options(-U_FORTIFY_SOURCE -D_FORTIFY_SOURCE=2 -fstack-protector-strong)
+  endif()
+
+elseif (VS_FLAVOR STREQUAL "asan")
+  if (MSVC)
+    add_compile_options(/fsanitize=address)
+  else()
+    add_compile_options(-fsanitize=address -fno-omit-frame-pointer)
+    add_link_options(-fsanitize=address)
+  endif()
+
+elseif (VS_FLAVOR STREQUAL "ubsan")
+  if (NOT _vs_gnu_like)
+    vs_flavor_unsupported(ubsan)
+  endif()
+  add_compile_options(-fsanitize=undefined -fno-omit-frame-pointer)
+  add_link_options(-fsanitize=undefined)
+
+else()
+  message(FATAL_ERROR "Unknown VS_FLAVOR '${VS_FLAVOR}'")
+endif()
+
+if (NOT VS_FLAVOR STREQUAL "")
+  message(STATUS "Visible Systems build flavor: ${VS_FLAVOR}")
+endif()
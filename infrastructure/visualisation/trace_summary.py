@@ -0,0 +1,70 @@
+import argparse
+import json
+from collections import defaultdict
+
+# Summarise a VS_ZONE trace (Chrome trace-event JSON written by
+# labs/common/trace.hpp). For the full timeline, open the same file in
+# https://ui.perfetto.dev or chrome://tracing.
+
+def load_trace(path):
+    with open(path, "r", encoding="utf-8") as f:
+        return json.load(f)
+
+def self_times(events):
+    # Zones on one thread nest strictly, so a stack over events sorted by
+    # start time gives each zone's time minus the time of its children.
+    out = []
+    stack = []
+    for ev in sorted(events, key=lambda e: (e["ts"], -e["dur"])):
+        end = ev["ts"] + ev["dur"]
+        while stack and stack[-1]["end"] <= ev["ts"]:
+            out.append(stack.pop())
+        frame = {"name": ev["name"], "end": end, "dur": ev["dur"], "self": ev["dur"]}
+        if stack:
+            stack[-1]["self"] -= ev["dur"]
+        stack.append(frame)
+    out.extend(stack)
+    return out
+
+def summarise(trace):
+    per_thread = defaultdict(list)
+    thread_names = {}
+    for ev in trace.get("traceEvents", []):
+        if ev.get("ph") == "X":
+            per_thread[ev["tid"]].append(ev)
+        elif ev.get("ph") == "M" and ev.get("name") == "thread_name":
+            thread_names[ev["tid"]] = ev["args"]["name"]
+
+    rows = {}
+    for tid, events in per_thread.items():
+        for z in self_times(events):
+            key = (thread_names.get(tid, str(tid)), z["name"])
+            r = rows.setdefault(key, {"count": 0, "total_us": 0.0, "self_us": 0.0, "max_us": 0.0})
+            r["count"] += 1
+            r["total_us"] += z["dur"]
+            r["self_us"] += z["self"]
+            r["max_us"] = max(r["max_us"], z["dur"])
+    return rows
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("trace", help="trace.json written next to the --out results")
+    ap.add_argument("--sort", choices=["self", "total", "count"], default="self")
+    args = ap.parse_args()
+
+    trace = load_trace(args.trace)
+    rows = summarise(trace)
+    key = {"self": "self_us", "total": "total_us", "count": "count"}[args.sort]
+
+    print(f"{'thread':<14} {'zone':<36} {'count':>8} {'total_ms':>12} {'self_ms':>12} {'mean_us':>12} {'max_us':>12}")
+    for (thread, name), r in sorted(rows.items(), key=lambda kv: kv[1][key], reverse=True):
+        mean = r["total_us"] / r["count"] if r["count"] else 0.0
+        print(f"{thread:<14} {name:<36} {r['count']:>8} {r['total_us'] / 1e3:>12.3f} "
+              f"{r['self_us'] / 1e3:>12.3f} {mean:>12.3f} {r['max_us']:>12.3f}")
+
+    dropped = trace.get("otherData", {}).get("dropped_events", 0)
+    if dropped:
+        print(f"\nwarning: {dropped} events were overwritten; raise VS_TRACE_BUFFER_EVENTS")
+
+if __name__ == "__main__":
+    main()
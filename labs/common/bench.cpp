@@ -8,11 +8,15 @@
 #include <cmath>
 #include <fstream>
 #include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
 #ifdef _WIN32
 #include "metrics_win.hpp"
 #endif
 
 #include "utils.hpp"
+#include "trace.hpp"
 
 namespace vs {
 
@@ -38,23 +42,6 @@ struct RunMetadata {
 #endif
 };
 
-// Minimal JSON writing without dependencies (safe for metadata + results)
-inline std::string json_escape(const std::string& s) {
-    std::string out;
-    out.reserve(s.size() + 8);
-    for (char c : s) {
-        switch (c) {
-            case '\\': out += "\\\\"; break;
-            case '"':  out += "\\\""; break;
-            case '\n': out += "\\n"; break;
-            case '\r': out += "\\r"; break;
-            case '\t': out += "\\t"; break;
-            default: out += c; break;
-        }
-    }
-    return out;
-}
-
 inline std::string utc_timestamp() {
     std::time_t t = std::time(nullptr);
     std::tm tm{};
@@ -85,6 +72,32 @@ inline std::string get_env(const char* k) {
 #endif
 }
 
+// Metadata shared by every result a lab writes; fill in `benchmark` per result.
+inline RunMetadata make_run_metadata(std::string suite) {
+    RunMetadata m{};
+    m.suite = std::move(suite);
+#if defined(NDEBUG)
+    m.build_type = "Release";
+#else
+    m.build_type = "DebugOrRelWithDebInfo";
+#endif
+#if defined(_MSC_VER)
+    m.compiler = "MSVC " + std::to_string(_MSC_VER);
+#elif defined(__clang__)
+    m.compiler = "Clang " __clang_version__;
+#elif defined(__GNUC__)
+    m.compiler = "GCC " __VERSION__;
+#else
+    m.compiler = "UnknownCompiler";
+#endif
+    m.timestamp_utc = utc_timestamp();
+    m.git_commit = get_env("GITHUB_SHA");
+#ifdef _WIN32
+    m.sys = get_system_info();
+#endif
+    return m;
+}
+
 inline void write_json_result(const std::string& path,
                               const RunMetadata& meta,
                               const BenchResult& r) {
@@ -126,6 +139,8 @@ inline double ns_since(const std::chrono::steady_clock::time_point& a,
 
 // Run `fn` repeatedly, measure each iteration duration.
 // Use small warmup to stabilize caches / JIT (none in C++) / CPU state.
+// With VS_ENABLE_TRACE each timed iteration is also recorded as a zone named
+// after the benchmark, so VS_ZONE markers inside `fn` nest under it.
 inline BenchResult bench(std::string name,
                          std::size_t warmup_iters,
                          std::size_t iters,
@@ -135,7 +150,13 @@ inline BenchResult bench(std::string name,
     std::vector<double> samples;
     samples.reserve(iters);
 
+#ifdef VS_ENABLE_TRACE
+    const char* zone_name = trace::intern(name);
+#endif
     for (std::size_t i = 0; i < iters; ++i) {
+#ifdef VS_ENABLE_TRACE
+        trace::Zone zone(zone_name);
+#endif
         const auto t0 = std::chrono::steady_clock::now();
         fn();
         const auto t1 = std::chrono::steady_clock::now();
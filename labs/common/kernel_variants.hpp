@@ -0,0 +1,104 @@
+#pragma once
+// Compile-time specialised read kernels and a runtime dispatcher over them.
+//
+// Every kernel comes in two flavours with an identical loop body:
+//   *_rt<T>(..., stride)   stride is a runtime value, as in the access lab
+//   *_ct<T, Stride>(...)   stride is a template constant the optimiser can
+//                          fold into addressing, unrolling and vectorisation
+//
+// strided<T>() / gather<T>() pick the *_ct instantiation for strides
+// 1..kMaxStride from a table built with std::index_sequence and fall back to
+// the *_rt loop for anything else. Sequential access is simply stride 1.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace vs::kv {
+
+constexpr std::size_t kMaxStride = 64;
+
+inline constexpr bool is_specialized(std::size_t stride) {
+    return stride >= 1 && stride <= kMaxStride;
+}
+
+template <class T>
+constexpr const char* type_name() {
+    if constexpr (std::is_same_v<T, std::uint8_t>) return "u8";
+    else if constexpr (std::is_same_v<T, std::uint16_t>) return "u16";
+    else if constexpr (std::is_same_v<T, std::uint32_t>) return "u32";
+    else if constexpr (std::is_same_v<T, std::uint64_t>) return "u64";
+    else if constexpr (std::is_same_v<T, float>) return "f32";
+    else if constexpr (std::is_same_v<T, double>) return "f64";
+    else return "unknown";
+}
+
+// xor for integers (matches the access lab); add for floating point, which
+// the compiler may only vectorise if it is allowed to reassociate.
+template <class T>
+inline T combine(T acc, T v) {
+    if constexpr (std::is_floating_point_v<T>) return acc + v;
+    else return (T)(acc ^ v);
+}
+
+template <class T>
+T strided_rt(const T* data, std::size_t n, std::size_t stride) {
+    T acc{};
+    for (std::size_t i = 0; i < n; i += stride) acc = combine(acc, data[i]);
+    return acc;
+}
+
+template <class T, std::size_t Stride>
+T strided_ct(const T* data, std::size_t n) {
+    static_assert(Stride >= 1);
+    T acc{};
+    for (std::size_t i = 0; i < n; i += Stride) acc = combine(acc, data[i]);
+    return acc;
+}
+
+// Gather: walk the index array with the given stride, load data[idx[i]].
+template <class T>
+T gather_rt(const T* data, const std::uint32_t* idx, std::size_t n, std::size_t stride) {
+    T acc{};
+    for (std::size_t i = 0; i < n; i += stride) acc = combine(acc, data[idx[i]]);
+    return acc;
+}
+
+template <class T, std::size_t Stride>
+T gather_ct(const T* data, const std::uint32_t* idx, std::size_t n) {
+    static_assert(Stride >= 1);
+    T acc{};
+    for (std::size_t i = 0; i < n; i += Stride) acc = combine(acc, data[idx[i]]);
+    return acc;
+}
+
+template <class T> using StridedFn = T (*)(const T*, std::size_t);
+template <class T> using GatherFn = T (*)(const T*, const std::uint32_t*, std::size_t);
+
+template <class T, std::size_t... I>
+constexpr std::array<StridedFn<T>, sizeof...(I)> make_strided_table(std::index_sequence<I...>) {
+    return {&strided_ct<T, I + 1>...};
+}
+
+template <class T, std::size_t... I>
+constexpr std::array<GatherFn<T>, sizeof...(I)> make_gather_table(std::index_sequence<I...>) {
+    return {&gather_ct<T, I + 1>...};
+}
+
+template <class T>
+T strided(const T* data, std::size_t n, std::size_t stride) {
+    static constexpr auto table = make_strided_table<T>(std::make_index_sequence<kMaxStride>{});
+    if (is_specialized(stride)) return table[stride - 1](data, n);
+    return strided_rt(data, n, stride);
+}
+
+template <class T>
+T gather(const T* data, const std::uint32_t* idx, std::size_t n, std::size_t stride) {
+    static constexpr auto table = make_gather_table<T>(std::make_index_sequence<kMaxStride>{});
+    if (is_specialized(stride)) return table[stride - 1](data, idx, n);
+    return gather_rt(data, idx, n, stride);
+}
+
+} // namespace vs::kv
@@ -0,0 +1,436 @@
+#pragma once
+// Roofline characterisation: measure what this host can do, then place each
+// kernel against it.
+//
+//   1. measure_peaks() runs scalar and SIMD multiply-add loops for peak f64
+//      FLOP/s, and a SIMD streaming read over working sets from 16 KiB upwards
+//      to get a bandwidth-vs-footprint curve.
+//   2. Each kernel declares a KernelWork (elements, bytes and flops per
+//      element, working-set footprint, floating-point element width).
+//   3. roofline_point() turns a BenchResult into achieved GFLOP/s, GB/s,
+//      arithmetic intensity and percent of the roof that applies to it. The
+//      bandwidth roof is read off the curve at the kernel's own footprint.
+//
+// Peaks are "what this build achieves", not datasheet numbers: the same
+// compiler flags that shape the kernels shape the probes. Best-of-N (min_ns)
+// timings are used on both sides so kernels and roofs are compared like for
+// like. A kernel that still lands above its roof is reported as a calibration
+// failure rather than a result.
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#endif
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#include "bench.hpp"
+
+namespace vs {
+
+struct CacheSizes {
+    std::size_t l1 = 32u << 10;     // fallbacks: a typical modern x86 core
+    std::size_t l2 = 1u << 20;
+    std::size_t l3 = 8u << 20;
+};
+
+inline CacheSizes detect_cache_sizes() {
+    CacheSizes c{};
+#if defined(_WIN32)
+    DWORD len = 0;
+    GetLogicalProcessorInformation(nullptr, &len);
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(len / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    if (!info.empty() && GetLogicalProcessorInformation(info.data(), &len)) {
+        for (const auto& i : info) {
+            if (i.Relationship != RelationCache) continue;
+            const auto& k = i.Cache;
+            if (k.Level == 1 && k.Type != CacheInstruction) c.l1 = k.Size;
+            if (k.Level == 2) c.l2 = k.Size;
+            if (k.Level == 3) c.l3 = k.Size;
+        }
+    }
+#elif defined(_SC_LEVEL1_DCACHE_SIZE)
+    if (long v = sysconf(_SC_LEVEL1_DCACHE_SIZE); v > 0) c.l1 = (std::size_t)v;
+    if (long v = sysconf(_SC_LEVEL2_CACHE_SIZE); v > 0) c.l2 = (std::size_t)v;
+    if (long v = sysconf(_SC_LEVEL3_CACHE_SIZE); v > 0) c.l3 = (std::size_t)v;
+#endif
+    return c;
+}
+
+// One point of the bandwidth-vs-footprint curve.
+struct BandwidthSample {
+    std::size_t probe_bytes{};
+    double gbps{};                // as measured
+    double roof_gbps{};           // upper envelope: max over this and every larger probe
+};
+
+// Summary per cache level, read off the curve at half the level's capacity.
+struct BandwidthLevel {
+    std::string name;             // "L1", "L2", "L3", "DRAM"
+    std::size_t capacity_bytes{}; // L3 is the per-core share, not the whole shared cache
+    double gbps{};
+};
+
+struct MachinePeaks {
+    double scalar_gflops{};       // f64
+    double simd_gflops{};         // f64; narrower types scale with lanes
+    std::string simd_isa;
+    std::vector<BandwidthSample> curve;
+    std::vector<BandwidthLevel> levels;
+};
+
+struct KernelWork {
+    std::size_t elements{};
+    double bytes_per_element{};   // traffic, at cache-line granularity where it matters
+    double flops_per_element{};   // 0 for pure data-movement kernels
+    std::size_t footprint_bytes{};
+    std::size_t fp_bytes = sizeof(double);  // width of the arithmetic: 4 for float kernels
+};
+
+struct RooflinePoint {
+    std::string name;
+    double gflops{};
+    double gbps{};
+    double intensity{};           // flop / byte
+    double roof_gflops{};         // attainable at this intensity (0 if no flops)
+    double roof_gbps{};           // bandwidth roof at this footprint
+    double pct_of_roof{};
+    std::size_t fp_bytes{};
+    std::string level;            // cache level the footprint fits in
+    std::string bound;            // "memory" or "compute"
+    bool above_roof = false;      // > 100%: the probes under-measured this host
+};
+
+namespace detail {
+
+inline volatile double roofline_fsink = 0.0;
+inline volatile std::uint64_t roofline_usink = 0;
+
+// Keeps independent scalar chains in separate registers so the
+// "scalar" peak is not quietly SLP-vectorised.
+inline void opaque(double& v) {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __asm__ volatile("" : "+x"(v));
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+    __asm__ volatile("" : "+w"(v));
+#else
+    (void)v;
+#endif
+}
+
+constexpr std::size_t kFlopIters = 1u << 22;
+constexpr int kChains = 8;   // enough independent chains to cover FMA latency x ports
+
+inline double scalar_madd_loop() {
+    double a[kChains];
+    for (int j = 0; j < kChains; ++j) a[j] = 1.0 + j * 1e-3;
+    const double m = 0.999999, c = 1e-6;
+    for (std::size_t i = 0; i < kFlopIters; ++i) {
+        for (int j = 0; j < kChains; ++j) {
+            a[j] = a[j] * m + c;
+            opaque(a[j]);
+        }
+    }
+    double s = 0.0;
+    for (int j = 0; j < kChains; ++j) s += a[j];
+    return s;
+}
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+constexpr const char* kSimdIsa = "avx2-fma";
+constexpr int kSimdLanes = 4;
+inline double simd_madd_loop() {
+    __m256d a[kChains];
+    for (int j = 0; j < kChains; ++j) a[j] = _mm256_set1_pd(1.0 + j * 1e-3);
+    const __m256d m = _mm256_set1_pd(0.999999), c = _mm256_set1_pd(1e-6);
+    for (std::size_t i = 0; i < kFlopIters; ++i)
+        for (int j = 0; j < kChains; ++j) a[j] = _mm256_fmadd_pd(a[j], m, c);
+    __m256d s = a[0];
+    for (int j = 1; j < kChains; ++j) s = _mm256_add_pd(s, a[j]);
+    alignas(32) double out[4];
+    _mm256_store_pd(out, s);
+    return out[0] + out[1] + out[2] + out[3];
+}
+#elif defined(__AVX__)
+constexpr const char* kSimdIsa = "avx";
+constexpr int kSimdLanes = 4;
+inline double simd_madd_loop() {
+    __m256d a[kChains];
+    for (int j = 0; j < kChains; ++j) a[j] = _mm256_set1_pd(1.0 + j * 1e-3);
+    const __m256d m = _mm256_set1_pd(0.999999), c = _mm256_set1_pd(1e-6);
+    for (std::size_t i = 0; i < kFlopIters; ++i)
+        for (int j = 0; j < kChains; ++j) a[j] = _mm256_add_pd(_mm256_mul_pd(a[j], m), c);
+    __m256d s = a[0];
+    for (int j = 1; j < kChains; ++j) s = _mm256_add_pd(s, a[j]);
+    alignas(32) double out[4];
+    _mm256_store_pd(out, s);
+    return out[0] + out[1] + out[2] + out[3];
+}
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+constexpr const char* kSimdIsa = "sse2";
+constexpr int kSimdLanes = 2;
+inline double simd_madd_loop() {
+    __m128d a[kChains];
+    for (int j = 0; j < kChains; ++j) a[j] = _mm_set1_pd(1.0 + j * 1e-3);
+    const __m128d m = _mm_set1_pd(0.999999), c = _mm_set1_pd(1e-6);
+    for (std::size_t i = 0; i < kFlopIters; ++i)
+        for (int j = 0; j < kChains; ++j) a[j] = _mm_add_pd(_mm_mul_pd(a[j], m), c);
+    __m128d s = a[0];
+    for (int j = 1; j < kChains; ++j) s = _mm_add_pd(s, a[j]);
+    alignas(16) double out[2];
+    _mm_store_pd(out, s);
+    return out[0] + out[1];
+}
+#else
+constexpr const char* kSimdIsa = "none";
+constexpr int kSimdLanes = 1;
+inline double simd_madd_loop() { return scalar_madd_loop(); }
+#endif
+
+// One pass over `n` words with the widest loads this build has, so the probe is
+// never narrower than an auto-vectorised kernel compiled with the same flags.
+inline std::uint64_t read_pass(const std::uint64_t* d, std::size_t n) {
+    std::size_t i = 0;
+    std::uint64_t acc = 0;
+#if defined(__AVX__)
+    __m256d a0 = _mm256_setzero_pd(), a1 = a0, a2 = a0, a3 = a0;
+    for (; i + 16 <= n; i += 16) {
+        const double* p = reinterpret_cast<const double*>(d + i);
+        a0 = _mm256_xor_pd(a0, _mm256_loadu_pd(p));
+        a1 = _mm256_xor_pd(a1, _mm256_loadu_pd(p + 4));
+        a2 = _mm256_xor_pd(a2, _mm256_loadu_pd(p + 8));
+        a3 = _mm256_xor_pd(a3, _mm256_loadu_pd(p + 12));
+    }
+    alignas(32) std::uint64_t out[4];
+    _mm256_store_pd(reinterpret_cast<double*>(out),
+                    _mm256_xor_pd(_mm256_xor_pd(a0, a1), _mm256_xor_pd(a2, a3)));
+    acc = out[0] ^ out[1] ^ out[2] ^ out[3];
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    __m128i a0 = _mm_setzero_si128(), a1 = a0, a2 = a0, a3 = a0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i* p = reinterpret_cast<const __m128i*>(d + i);
+        a0 = _mm_xor_si128(a0, _mm_loadu_si128(p));
+        a1 = _mm_xor_si128(a1, _mm_loadu_si128(p + 1));
+        a2 = _mm_xor_si128(a2, _mm_loadu_si128(p + 2));
+        a3 = _mm_xor_si128(a3, _mm_loadu_si128(p + 3));
+    }
+    alignas(16) std::uint64_t out[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(out),
+                    _mm_xor_si128(_mm_xor_si128(a0, a1), _mm_xor_si128(a2, a3)));
+    acc = out[0] ^ out[1];
+#endif
+    for (; i < n; ++i) acc ^= d[i];
+    return acc;
+}
+
+// Streaming read of `buf`, repeated until ~128 MiB has been read so every
+// footprint gets a sample long enough to time.
+inline double measure_read_gbps(const std::vector<std::uint64_t>& buf) {
+    const std::size_t bytes = buf.size() * sizeof(std::uint64_t);
+    const std::size_t passes = std::max<std::size_t>(1, (std::size_t(128) << 20) / bytes);
+    auto r = bench("roofline_read_probe", 1, 5, [&] {
+        for (std::size_t p = 0; p < passes; ++p) roofline_usink = read_pass(buf.data(), buf.size());
+    });
+    return (double)(passes * bytes) / r.min_ns;
+}
+
+} // namespace detail
+
+// Roof at a footprint: the envelope at the largest probe that is not bigger
+// than it (the smallest probe for footprints below 16 KiB).
+inline double bandwidth_roof(const MachinePeaks& p, std::size_t footprint_bytes) {
+    double roof = p.curve.empty() ? 0.0 : p.curve.front().roof_gbps;
+    for (const auto& s : p.curve)
+        if (s.probe_bytes <= footprint_bytes) roof = s.roof_gbps;
+    return roof;
+}
+
+inline const std::string& level_of(const MachinePeaks& p, std::size_t footprint_bytes) {
+    for (const auto& lvl : p.levels)
+        if (footprint_bytes <= lvl.capacity_bytes) return lvl.name;
+    return p.levels.back().name;
+}
+
+// f64 peak scaled to the kernel's element width (twice the lanes for float).
+inline double compute_roof(const MachinePeaks& p, std::size_t fp_bytes) {
+    return p.simd_gflops * (double)sizeof(double) / (double)std::max<std::size_t>(1, fp_bytes);
+}
+
+inline MachinePeaks measure_peaks() {
+    MachinePeaks p{};
+
+    const double madd_flops = 2.0 * detail::kChains * (double)detail::kFlopIters;
+    {
+        auto r = bench("roofline_scalar_madd", 2, 7, [] { detail::roofline_fsink = detail::scalar_madd_loop(); });
+        p.scalar_gflops = madd_flops / r.min_ns;
+    }
+    {
+        auto r = bench("roofline_simd_madd", 2, 7, [] { detail::roofline_fsink = detail::simd_madd_loop(); });
+        p.simd_gflops = madd_flops * detail::kSimdLanes / r.min_ns;
+        p.simd_isa = detail::kSimdIsa;
+    }
+
+    // Footprints from 16 KiB doubling to well past the per-core L3 share
+    // (capped: server L3s can report hundreds of MiB).
+    const CacheSizes c = detect_cache_sizes();
+    const std::size_t cores = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    const std::size_t l3_share = std::max(c.l2, c.l3 / cores);
+    const std::size_t largest = std::min<std::size_t>(std::max<std::size_t>(std::size_t(256) << 20, c.l3 * 4),
+                                                      std::size_t(512) << 20);
+    for (std::size_t bytes = std::size_t(16) << 10; bytes <= largest; bytes *= 2) {
+        std::vector<std::uint64_t> buf(bytes / sizeof(std::uint64_t), 1);
+        p.curve.push_back({bytes, detail::measure_read_gbps(buf), 0.0});
+    }
+
+    // Bandwidth only falls as the footprint grows, so anything a larger probe
+    // achieved is also attainable at a smaller one. The envelope absorbs noise
+    // and keeps every roof an upper bound.
+    double env = 0.0;
+    for (auto it = p.curve.rbegin(); it != p.curve.rend(); ++it) {
+        env = std::max(env, it->gbps);
+        it->roof_gbps = env;
+    }
+
+    p.levels = {
+        {"L1",   c.l1,     0.0},
+        {"L2",   c.l2,     0.0},
+        {"L3",   l3_share, 0.0},
+        {"DRAM", SIZE_MAX, p.curve.back().roof_gbps},
+    };
+    for (std::size_t i = 0; i + 1 < p.levels.size(); ++i)
+        p.levels[i].gbps = bandwidth_roof(p, p.levels[i].capacity_bytes / 2);
+    return p;
+}
+
+inline RooflinePoint roofline_point(const BenchResult& r, const KernelWork& w, const MachinePeaks& p) {
+    RooflinePoint pt{};
+    pt.name = r.name;
+    const double flops = w.flops_per_element * (double)w.elements;
+    const double bytes = w.bytes_per_element * (double)w.elements;
+    pt.gflops = flops / r.min_ns;
+    pt.gbps = bytes / r.min_ns;
+    pt.intensity = bytes > 0.0 ? flops / bytes : 0.0;
+
+    pt.fp_bytes = w.fp_bytes;
+    pt.level = level_of(p, w.footprint_bytes);
+    pt.roof_gbps = bandwidth_roof(p, w.footprint_bytes);
+    if (flops > 0.0) {
+        const double peak = compute_roof(p, w.fp_bytes);
+        const double mem_roof = pt.intensity * pt.roof_gbps;
+        pt.roof_gflops = std::min(peak, mem_roof);
+        pt.bound = mem_roof < peak ? "memory" : "compute";
+        pt.pct_of_roof = 100.0 * pt.gflops / pt.roof_gflops;
+    } else {
+        pt.bound = "memory";
+        pt.pct_of_roof = 100.0 * pt.gbps / pt.roof_gbps;
+    }
+    pt.above_roof = pt.pct_of_roof > 100.0;
+    return pt;
+}
+
+inline void print_peaks(std::ostream& os, const MachinePeaks& p) {
+    os << "roofline_peaks scalar_gflops=" << p.scalar_gflops
+       << " simd_gflops=" << p.simd_gflops << " simd_isa=" << p.simd_isa;
+    for (const auto& lvl : p.levels) os << " " << lvl.name << "_gbps=" << lvl.gbps;
+    os << "\n";
+}
+
+inline void print_roofline_header(std::ostream& os) {
+    os << "name,gflops,gbps,intensity,roof_gflops,roof_gbps,pct_of_roof,fp_bytes,level,bound,calibration\n";
+}
+
+inline void print_roofline_row(std::ostream& os, const RooflinePoint& pt) {
+    os << csv_escape(pt.name) << ","
+       << pt.gflops << ","
+       << pt.gbps << ","
+       << pt.intensity << ","
+       << pt.roof_gflops << ","
+       << pt.roof_gbps << ","
+       << pt.pct_of_roof << ","
+       << pt.fp_bytes << ","
+       << pt.level << ","
+       << pt.bound << ","
+       << (pt.above_roof ? "FAILED" : "ok") << "\n";
+}
+
+// Header + rows; points above their roof are called out on stderr because
+// their percentages say more about the probes than about the kernel.
+inline void print_roofline(std::ostream& os, const std::vector<RooflinePoint>& points) {
+    print_roofline_header(os);
+    for (const auto& pt : points) {
+        print_roofline_row(os, pt);
+        if (pt.above_roof)
+            std::cerr << "roofline calibration failure: " << pt.name << " at "
+                      << pt.pct_of_roof << "% of its roof\n";
+    }
+}
+
+inline void write_json_roofline(const std::string& path,
+                                const RunMetadata& meta,
+                                const MachinePeaks& p,
+                                const std::vector<RooflinePoint>& points) {
+    std::ofstream os(path, std::ios::binary);
+    os << "{\n";
+    os << "  \"suite\": \"" << json_escape(meta.suite) << "\",\n";
+    os << "  \"build_type\": \"" << json_escape(meta.build_type) << "\",\n";
+    os << "  \"compiler\": \"" << json_escape(meta.compiler) << "\",\n";
+    os << "  \"timestamp_utc\": \"" << json_escape(meta.timestamp_utc) << "\",\n";
+    os << "  \"git_commit\": \"" << json_escape(meta.git_commit) << "\",\n";
+    os << "  \"peaks\": {\n";
+    os << "    \"scalar_gflops\": " << p.scalar_gflops << ",\n";
+    os << "    \"simd_gflops\": " << p.simd_gflops << ",\n";
+    os << "    \"simd_isa\": \"" << json_escape(p.simd_isa) << "\",\n";
+    os << "    \"bandwidth\": [";
+    for (std::size_t i = 0; i < p.levels.size(); ++i) {
+        const auto& lvl = p.levels[i];
+        os << (i ? ",\n" : "\n")
+           << "      {\"level\": \"" << lvl.name << "\", \"capacity_bytes\": "
+           << (lvl.capacity_bytes == SIZE_MAX ? 0 : lvl.capacity_bytes)
+           << ", \"gbps\": " << lvl.gbps << "}";
+    }
+    os << "\n    ],\n";
+    os << "    \"bandwidth_curve\": [";
+    for (std::size_t i = 0; i < p.curve.size(); ++i) {
+        const auto& smp = p.curve[i];
+        os << (i ? ",\n" : "\n")
+           << "      {\"probe_bytes\": " << smp.probe_bytes << ", \"gbps\": " << smp.gbps
+           << ", \"roof_gbps\": " << smp.roof_gbps << "}";
+    }
+    os << "\n    ]\n";
+    os << "  },\n";
+    os << "  \"kernels\": [";
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        const auto& pt = points[i];
+        os << (i ? ",\n" : "\n")
+           << "    {\"name\": \"" << json_escape(pt.name) << "\""
+           << ", \"gflops\": " << pt.gflops
+           << ", \"gbps\": " << pt.gbps
+           << ", \"intensity\": " << pt.intensity
+           << ", \"roof_gflops\": " << pt.roof_gflops
+           << ", \"roof_gbps\": " << pt.roof_gbps
+           << ", \"pct_of_roof\": " << pt.pct_of_roof
+           << ", \"fp_bytes\": " << pt.fp_bytes
+           << ", \"level\": \"" << pt.level << "\""
+           << ", \"bound\": \"" << pt.bound << "\""
+           << ", \"calibration\": \"" << (pt.above_roof ? "failed" : "ok") << "\"}";
+    }
+    os << "\n  ]\n";
+    os << "}\n";
+}
+
+} // namespace vs
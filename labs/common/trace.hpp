@@ -0,0 +1,227 @@
+#pragma once
+// Scoped tracing zones for looking *inside* a benchmark iteration.
+//
+//   VS_ZONE("build_index");   // records [scope entry, scope exit) on this thread
+//
+// Each thread owns a fixed-size ring buffer of events. Recording a zone is two
+// timestamp reads and one store into that buffer: no locks, no allocation, no
+// syscalls. The first zone on a thread registers its buffer with a lock-free
+// list so write_chrome_trace() can find it after the run.
+//
+// Tracing is compiled out unless VS_ENABLE_TRACE is defined (CMake option of the
+// same name). When disabled VS_ZONE expands to nothing and flush_to_dir() does
+// nothing, so markers can stay in hot loops and labs need no #ifdefs; the
+// disabled path pulls in nothing beyond <string>.
+//
+// VS_ENABLE_TRACE must be uniform across a program: this header and vs::bench()
+// define different inline functions with and without it. CMake applies it to
+// every lab through vs_memory_common's INTERFACE definitions.
+//
+// Output is Chrome trace-event JSON: open it in chrome://tracing or
+// https://ui.perfetto.dev, or summarise it with
+// infrastructure/visualisation/trace_summary.py.
+
+#include <string>
+
+#ifndef VS_ENABLE_TRACE
+
+namespace vs::trace {
+inline void flush_to_dir(const std::string&) {}
+} // namespace vs::trace
+
+#define VS_ZONE(name) ((void)0)
+
+#else
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <filesystem>
+#include <set>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define VS_TRACE_HAS_TSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define VS_TRACE_HAS_TSC 1
+#endif
+
+#include "utils.hpp"
+
+// Events kept per thread. Older events are overwritten once a thread wraps.
+#ifndef VS_TRACE_BUFFER_EVENTS
+#define VS_TRACE_BUFFER_EVENTS (1u << 16)
+#endif
+
+namespace vs::trace {
+
+static_assert((VS_TRACE_BUFFER_EVENTS & (VS_TRACE_BUFFER_EVENTS - 1)) == 0,
+              "VS_TRACE_BUFFER_EVENTS must be a power of two");
+
+// Raw timestamp in ticks. On x86 this is the TSC (invariant on every CPU we
+// care about); elsewhere it falls back to steady_clock nanoseconds.
+inline std::uint64_t now_ticks() {
+#ifdef VS_TRACE_HAS_TSC
+    return __rdtsc();
+#else
+    return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+struct Event {
+    const char* name;       // must outlive the trace (string literal or intern())
+    std::uint64_t begin;    // ticks
+    std::uint64_t end;      // ticks
+};
+
+struct ThreadBuffer {
+    std::uint32_t tid = 0;
+    // Total events ever written. Only the owning thread stores to it; readers
+    // load it with acquire so every slot below `head` is fully written.
+    std::atomic<std::uint64_t> head{0};
+    ThreadBuffer* next = nullptr;
+    Event events[VS_TRACE_BUFFER_EVENTS];
+};
+
+// Reference point used to convert ticks to wall time at flush.
+struct Epoch {
+    std::uint64_t ticks;
+    std::chrono::steady_clock::time_point wall;
+};
+
+inline const Epoch& epoch() {
+    static const Epoch e{now_ticks(), std::chrono::steady_clock::now()};
+    return e;
+}
+
+inline std::atomic<ThreadBuffer*>& registry() {
+    static std::atomic<ThreadBuffer*> head{nullptr};
+    return head;
+}
+
+inline std::atomic<std::uint32_t>& next_tid() {
+    static std::atomic<std::uint32_t> n{0};
+    return n;
+}
+
+// Buffers are deliberately never freed: a thread may exit before the flush,
+// and its events must still be readable afterwards.
+inline ThreadBuffer* register_thread() {
+    (void)epoch();
+    auto* b = new ThreadBuffer();
+    b->tid = next_tid().fetch_add(1, std::memory_order_relaxed);
+    auto& reg = registry();
+    b->next = reg.load(std::memory_order_relaxed);
+    while (!reg.compare_exchange_weak(b->next, b,
+                                      std::memory_order_release,
+                                      std::memory_order_relaxed)) {
+    }
+    return b;
+}
+
+inline ThreadBuffer& this_thread_buffer() {
+    thread_local ThreadBuffer* b = register_thread();
+    return *b;
+}
+
+inline void record(ThreadBuffer& b, const char* name, std::uint64_t begin, std::uint64_t end) {
+    const std::uint64_t h = b.head.load(std::memory_order_relaxed);
+    b.events[h & (VS_TRACE_BUFFER_EVENTS - 1)] = Event{name, begin, end};
+    b.head.store(h + 1, std::memory_order_release);
+}
+
+// Gives runtime strings (e.g. benchmark names) a stable address for Event::name.
+// Takes a lock, so call it once per benchmark, not per zone.
+inline const char* intern(const std::string& s) {
+    static std::mutex m;
+    static std::set<std::string> names;
+    std::lock_guard<std::mutex> lock(m);
+    return names.insert(s).first->c_str();
+}
+
+class Zone {
+public:
+    // The buffer is looked up first so a thread's very first zone never
+    // starts before the epoch its timestamps are measured from.
+    explicit Zone(const char* name)
+        : buf_(this_thread_buffer()), name_(name), begin_(now_ticks()) {}
+    ~Zone() { record(buf_, name_, begin_, now_ticks()); }
+
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+
+private:
+    ThreadBuffer& buf_;
+    const char* name_;
+    std::uint64_t begin_;
+};
+
+// Write every registered buffer as Chrome trace-event JSON ("X" complete
+// events, microsecond timestamps relative to the first traced thread).
+// Call after worker threads have joined; zones still being recorded while
+// this runs may be torn.
+inline void write_chrome_trace(const std::string& path) {
+    const Epoch& e = epoch();
+    const std::uint64_t t1 = now_ticks();
+    const auto w1 = std::chrono::steady_clock::now();
+    const double wall_ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(w1 - e.wall).count();
+    const double ticks_per_ns = wall_ns > 0.0 ? (double)(t1 - e.ticks) / wall_ns : 1.0;
+    const auto to_us = [&](std::uint64_t t) {
+        return (double)(t - e.ticks) / ticks_per_ns / 1000.0;
+    };
+
+    ThreadBuffer* const buffers = registry().load(std::memory_order_acquire);
+    std::uint64_t dropped = 0;
+    for (ThreadBuffer* b = buffers; b; b = b->next) {
+        const std::uint64_t h = b->head.load(std::memory_order_acquire);
+        if (h > VS_TRACE_BUFFER_EVENTS) dropped += h - VS_TRACE_BUFFER_EVENTS;
+    }
+
+    std::ofstream os(path, std::ios::binary);
+    os << std::fixed << std::setprecision(3);
+    os << "{\n";
+    os << "  \"displayTimeUnit\": \"ns\",\n";
+    os << "  \"otherData\": { \"ticks_per_ns\": " << ticks_per_ns
+       << ", \"dropped_events\": " << dropped << " },\n";
+    os << "  \"traceEvents\": [";
+
+    bool first = true;
+    for (ThreadBuffer* b = buffers; b; b = b->next) {
+        const std::uint64_t h = b->head.load(std::memory_order_acquire);
+        const std::uint64_t n = h < VS_TRACE_BUFFER_EVENTS ? h : VS_TRACE_BUFFER_EVENTS;
+
+        os << (first ? "\n" : ",\n");
+        first = false;
+        os << "    {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": " << b->tid
+           << ", \"args\": {\"name\": \"vs-thread-" << b->tid << "\"}}";
+
+        for (std::uint64_t i = h - n; i < h; ++i) {
+            const Event& ev = b->events[i & (VS_TRACE_BUFFER_EVENTS - 1)];
+            os << ",\n    {\"name\": \"" << json_escape(ev.name) << "\", \"ph\": \"X\""
+               << ", \"pid\": 0, \"tid\": " << b->tid
+               << ", \"ts\": " << to_us(ev.begin)
+               << ", \"dur\": " << (double)(ev.end - ev.begin) / ticks_per_ns / 1000.0 << "}";
+        }
+    }
+    os << "\n  ]\n";
+    os << "}\n";
+}
+
+// Writes trace.json next to a lab's --out results; no-op without --out.
+inline void flush_to_dir(const std::string& out_dir) {
+    if (out_dir.empty()) return;
+    write_chrome_trace((std::filesystem::path(out_dir) / "trace.json").string());
+}
+
+} // namespace vs::trace
+
+#define VS_TRACE_CONCAT_INNER(a, b) a##b
+#define VS_TRACE_CONCAT(a, b) VS_TRACE_CONCAT_INNER(a, b)
+#define VS_ZONE(name) ::vs::trace::Zone VS_TRACE_CONCAT(vs_zone_, __LINE__)(name)
+
+#endif // VS_ENABLE_TRACE
@@ -1,9 +1,13 @@
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <cstdint>
+#include <filesystem>
+#include <string>
 
 #include "bench.hpp"
 #include "utils.hpp"
+#include "roofline.hpp"
 
 namespace {
 volatile std::uint64_t usink = 0;
@@ -20,12 +24,45 @@ int main(int argc, char** argv) {
     if (argc > 3) stride = std::stoull(argv[3]);
     if (argc > 4) seed = std::stoull(argv[4]);
 
+    std::string out_dir;
+    bool roofline = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--out" && i + 1 < argc) out_dir = argv[++i];
+        if (a == "--roofline") roofline = true;
+    }
+    if (!out_dir.empty()) std::filesystem::create_directories(out_dir);
+
     std::vector<std::uint64_t> data(N);
-    for (std::size_t i = 0; i < N; ++i) data[i] = (std::uint64_t)i * 11400714819323198485ULL;
+    {
+        VS_ZONE("init_data");
+        for (std::size_t i = 0; i < N; ++i) data[i] = (std::uint64_t)i * 11400714819323198485ULL;
+    }
 
-    const auto rnd = vs::make_shuffled_indices(N, seed);
+    std::vector<std::size_t> rnd;
+    {
+        VS_ZONE("shuffle_indices");
+        rnd = vs::make_shuffled_indices(N, seed);
+    }
 
     std::cout << "access_patterns_bench N=" << N << " iters=" << iters << " stride=" << stride << "\n";
+
+    // All three kernels are pure data movement (xor is not a flop), so their
+    // roof is the bandwidth of whichever level holds the touched data.
+    // Random reads are charged a whole cache line each, strided reads up to
+    // one line: that is the traffic the memory system actually moves.
+    constexpr double line = 64.0;
+    const std::size_t data_bytes = N * sizeof(std::uint64_t);
+    const std::size_t strided_elems = stride ? (N + stride - 1) / stride : 0;
+    const double strided_bytes = std::min(line, (double)(stride * sizeof(std::uint64_t)));
+
+    vs::MachinePeaks peaks{};
+    std::vector<vs::RooflinePoint> points;
+    if (roofline) {
+        peaks = vs::measure_peaks();
+        vs::print_peaks(std::cout, peaks);
+    }
+
     vs::print_csv_header(std::cout);
 
     // Sequential
@@ -36,6 +73,7 @@ int main(int argc, char** argv) {
             usink ^= acc;
         });
         vs::print_csv_row(std::cout, r);
+        if (roofline) points.push_back(vs::roofline_point(r, {N, sizeof(std::uint64_t), 0.0, data_bytes}, peaks));
     }
 
     // Random
@@ -46,6 +84,7 @@ int main(int argc, char** argv) {
             usink ^= acc;
         });
         vs::print_csv_row(std::cout, r);
+        if (roofline) points.push_back(vs::roofline_point(r, {N, line + sizeof(std::size_t), 0.0, data_bytes + N * sizeof(std::size_t)}, peaks));
     }
 
     // Strided
@@ -56,8 +95,19 @@ int main(int argc, char** argv) {
             usink ^= acc;
         });
         vs::print_csv_row(std::cout, r);
+        if (roofline) points.push_back(vs::roofline_point(r, {strided_elems, strided_bytes, 0.0, data_bytes}, peaks));
+    }
+
+    if (roofline) {
+        std::cout << "\n";
+        vs::print_roofline(std::cout, points);
+        if (!out_dir.empty())
+            vs::write_json_roofline((std::filesystem::path(out_dir) / "roofline.json").string(),
+                                    vs::make_run_metadata("memory.access"), peaks, points);
     }
 
     std::cerr << "usink=" << usink << "\n";
+
+    vs::trace::flush_to_dir(out_dir);
     return 0;
 }
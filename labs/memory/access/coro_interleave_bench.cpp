@@ -0,0 +1,272 @@
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <coroutine>
+#include <exception>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <utility>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "bench.hpp"
+#include "utils.hpp"
+
+// Hiding the latency of *dependent* loads.
+//
+// A chained hash table is walked node by node: the address of node k+1 is only
+// known once node k has arrived from DRAM, so a hardware or software prefetch
+// cannot run ahead within one lookup. What *can* overlap is work across
+// independent lookups. Three ways to get there:
+//
+//   sequential      one lookup at a time; every hop is a full miss
+//   group_prefetch  G lookups advance in lockstep, hand-written: prefetch the
+//                   next node for each of them, then visit each of them
+//   coro            each lookup is a C++20 coroutine that prefetches its next
+//                   node and suspends; a round-robin scheduler resumes the
+//                   other G-1 lookups while the line is in flight
+//
+// Group prefetching needs every lookup in a group to take the same number of
+// steps (true here: all chains have length L). Coroutines do not, which is why
+// they are the technique worth measuring for real index lookups.
+
+namespace {
+
+struct alignas(64) Node {   // one node per cache line, so every hop is one miss
+    std::uint64_t key;
+    std::uint64_t value;
+    const Node* next;
+};
+
+struct ChainTable {
+    std::vector<Node> nodes;
+    std::vector<const Node*> heads;
+    std::size_t chain_len = 1;
+
+    std::size_t bucket_of(std::uint64_t key) const { return (std::size_t)(key / chain_len); }
+};
+
+// Nodes of every chain are scattered over the whole array so consecutive hops
+// land on unrelated lines (and usually unrelated pages).
+ChainTable build_table(std::size_t n_nodes, std::size_t chain_len, std::uint64_t seed) {
+    ChainTable t;
+    t.chain_len = chain_len;
+    const std::size_t chains = n_nodes / chain_len;
+    t.nodes.resize(chains * chain_len);
+    t.heads.resize(chains);
+
+    const auto pos = vs::make_shuffled_indices(t.nodes.size(), seed);
+    for (std::size_t c = 0; c < chains; ++c) {
+        const Node* next = nullptr;
+        for (std::size_t j = chain_len; j-- > 0;) {
+            const std::uint64_t key = (std::uint64_t)(c * chain_len + j);
+            Node& n = t.nodes[pos[c * chain_len + j]];
+            n = Node{key, key * 0x9e3779b97f4a7c15ULL, next};
+            next = &n;
+        }
+        t.heads[c] = next;
+    }
+    return t;
+}
+
+// Every query asks for the tail of a random chain, so each lookup walks
+// exactly chain_len nodes.
+std::vector<std::uint64_t> make_queries(const ChainTable& t, std::size_t count, std::uint64_t seed) {
+    std::vector<std::uint64_t> q(count);
+    std::mt19937_64 rng(seed ^ 0x5bd1e995u);
+    std::uniform_int_distribution<std::size_t> pick(0, t.heads.size() - 1);
+    for (auto& k : q) k = (std::uint64_t)(pick(rng) * t.chain_len + t.chain_len - 1);
+    return q;
+}
+
+inline void prefetch(const void* p) {
+#if defined(_MSC_VER)
+    _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+    __builtin_prefetch(p);
+#endif
+}
+
+std::uint64_t lookup(const ChainTable& t, std::uint64_t key) {
+    for (const Node* n = t.heads[t.bucket_of(key)]; n; n = n->next)
+        if (n->key == key) return n->value;
+    return 0;
+}
+
+std::uint64_t run_sequential(const ChainTable& t, const std::vector<std::uint64_t>& queries) {
+    std::uint64_t acc = 0;
+    for (std::uint64_t k : queries) acc += lookup(t, k);
+    return acc;
+}
+
+std::uint64_t run_group_prefetch(const ChainTable& t, const std::vector<std::uint64_t>& queries, std::size_t group) {
+    std::vector<const Node*> cur(group);
+    std::uint64_t acc = 0;
+    for (std::size_t base = 0; base < queries.size(); base += group) {
+        const std::size_t g_n = std::min(group, queries.size() - base);
+
+        // Stage 0: bucket heads.
+        for (std::size_t g = 0; g < g_n; ++g) prefetch(&t.heads[t.bucket_of(queries[base + g])]);
+        for (std::size_t g = 0; g < g_n; ++g) {
+            cur[g] = t.heads[t.bucket_of(queries[base + g])];
+            prefetch(cur[g]);
+        }
+
+        // Stages 1..L: visit every lookup's current node, prefetch its next.
+        for (std::size_t step = 0; step < t.chain_len; ++step) {
+            for (std::size_t g = 0; g < g_n; ++g) {
+                const Node* n = cur[g];
+                if (!n) continue;
+                if (n->key == queries[base + g]) {
+                    acc += n->value;
+                    cur[g] = nullptr;
+                } else {
+                    cur[g] = n->next;
+                    if (cur[g]) prefetch(cur[g]);
+                }
+            }
+        }
+    }
+    return acc;
+}
+
+// Minimal coroutine type: lazily started, resumed only by the scheduler below.
+struct LookupTask {
+    struct promise_type {
+        LookupTask get_return_object() {
+            return LookupTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    explicit LookupTask(std::coroutine_handle<promise_type> h) : h(h) {}
+    LookupTask(LookupTask&& o) noexcept : h(std::exchange(o.h, {})) {}
+    LookupTask(const LookupTask&) = delete;
+    LookupTask& operator=(const LookupTask&) = delete;
+    LookupTask& operator=(LookupTask&&) = delete;
+    ~LookupTask() { if (h) h.destroy(); }
+
+    std::coroutine_handle<promise_type> h;
+};
+
+// One coroutine per scheduler slot, each handling queries slot, slot+G, ...
+// so coroutine frames are allocated G times per run rather than once per lookup.
+LookupTask lookup_slot(const ChainTable& t, const std::vector<std::uint64_t>& queries,
+                       std::size_t first, std::size_t step, std::uint64_t& out) {
+    for (std::size_t i = first; i < queries.size(); i += step) {
+        const std::uint64_t key = queries[i];
+        const Node* const* head = &t.heads[t.bucket_of(key)];
+        prefetch(head);
+        co_await std::suspend_always{};
+
+        for (const Node* n = *head; n; n = n->next) {
+            prefetch(n);
+            co_await std::suspend_always{};
+            if (n->key == key) {
+                out += n->value;
+                break;
+            }
+        }
+    }
+}
+
+std::uint64_t run_coro(const ChainTable& t, const std::vector<std::uint64_t>& queries, std::size_t group) {
+    std::vector<std::uint64_t> acc(group, 0);
+    std::vector<LookupTask> tasks;
+    tasks.reserve(group);
+    for (std::size_t g = 0; g < group; ++g) tasks.push_back(lookup_slot(t, queries, g, group, acc[g]));
+
+    // Round-robin: by the time a task is resumed again, its prefetch has had
+    // G-1 other lookups' worth of work to complete behind.
+    std::size_t live = tasks.size();
+    while (live) {
+        for (auto& task : tasks) {
+            if (task.h.done()) continue;
+            task.h.resume();
+            if (task.h.done()) --live;
+        }
+    }
+
+    std::uint64_t sum = 0;
+    for (std::uint64_t a : acc) sum += a;
+    return sum;
+}
+
+volatile std::uint64_t usink = 0;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t nodes = 1u << 21;   // 64-byte nodes: 128 MiB, past a desktop L3
+    std::size_t visits = 1u << 22;  // node visits per run, same for every chain length
+    std::size_t iters = 5;
+    std::uint64_t seed = 12345;
+
+    if (argc > 1) nodes = std::stoull(argv[1]);
+    if (argc > 2) visits = std::stoull(argv[2]);
+    if (argc > 3) iters = std::stoull(argv[3]);
+    if (argc > 4) seed = std::stoull(argv[4]);
+
+    std::string out_dir;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--out" && i + 1 < argc) out_dir = argv[++i];
+    }
+    if (!out_dir.empty()) std::filesystem::create_directories(out_dir);
+
+    const std::size_t chain_lens[] = {1, 4, 16, 64};
+    const std::size_t groups[] = {1, 4, 8, 16, 32};
+
+    std::cout << "coro_interleave_bench nodes=" << nodes << " visits=" << visits
+              << " iters=" << iters << " node_bytes=" << sizeof(Node) << "\n";
+    vs::print_csv_header(std::cout);
+
+    bool ok = true;
+    for (std::size_t len : chain_lens) {
+        if (len > nodes) continue;
+        ChainTable table;
+        std::vector<std::uint64_t> queries;
+        {
+            VS_ZONE("build_table");
+            table = build_table(nodes, len, seed);
+            queries = make_queries(table, std::max<std::size_t>(1, visits / len), seed);
+        }
+        const std::string suffix = "_L" + std::to_string(len);
+        const std::uint64_t expect = run_sequential(table, queries);
+
+        auto r = vs::bench("sequential" + suffix, 1, iters, [&] {
+            usink = run_sequential(table, queries);
+        });
+        vs::print_csv_row(std::cout, r);
+
+        for (std::size_t g : groups) {
+            const std::string gs = suffix + "_G" + std::to_string(g);
+
+            auto rg = vs::bench("group_prefetch" + gs, 1, iters, [&] {
+                usink = run_group_prefetch(table, queries, g);
+            });
+            vs::print_csv_row(std::cout, rg);
+
+            auto rc = vs::bench("coro" + gs, 1, iters, [&] {
+                usink = run_coro(table, queries, g);
+            });
+            vs::print_csv_row(std::cout, rc);
+
+            if (run_group_prefetch(table, queries, g) != expect || run_coro(table, queries, g) != expect) {
+                std::cerr << "checksum mismatch at " << gs.substr(1) << "\n";
+                ok = false;
+            }
+        }
+    }
+
+    std::cerr << "usink=" << usink << "\n";
+
+    vs::trace::flush_to_dir(out_dir);
+    return ok ? 0 : 1;
+}
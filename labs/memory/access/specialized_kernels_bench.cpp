@@ -0,0 +1,127 @@
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <string>
+
+#include "bench.hpp"
+#include "kernel_variants.hpp"
+
+// How much does the compiler gain from *knowing* the stride and element type?
+//
+// For each element type the sequential (stride 1), strided and gather kernels
+// run twice over the same bytes: once through the runtime-stride loop and once
+// through the compile-time specialisation picked by vs::kv's dispatcher.
+// The buffer size in bytes is fixed, so narrower types mean more elements.
+
+namespace {
+
+volatile std::uint64_t usink = 0;
+volatile double fsink = 0.0;
+
+// Read through a volatile so the runtime twin really sees a runtime stride
+// (otherwise inlining + constant propagation could specialise it anyway).
+volatile std::size_t runtime_stride = 1;
+
+template <class T>
+void sink(T v) {
+    if constexpr (std::is_floating_point_v<T>) fsink = (double)v;
+    else usink = (std::uint64_t)v;
+}
+
+template <class T>
+void run_type(std::size_t bytes, std::size_t iters, const std::vector<std::size_t>& strides, std::uint64_t seed) {
+    const std::size_t n = bytes / sizeof(T);
+    std::vector<T> data(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if constexpr (std::is_floating_point_v<T>) data[i] = (T)(i & 1023) * (T)0.5;
+        else data[i] = (T)(i * 2654435761u);
+    }
+
+    // Gather indices cover the same byte budget as a u64 pass.
+    const std::size_t n_idx = std::max<std::size_t>(1, bytes / sizeof(std::uint64_t));
+    std::vector<std::uint32_t> idx(n_idx);
+    std::mt19937_64 rng(seed);
+    for (auto& x : idx) x = (std::uint32_t)(rng() % n);
+
+    const std::string t = vs::kv::type_name<T>();
+    const auto spec = [](std::size_t s) { return vs::kv::is_specialized(s) ? "_spec" : "_fallback"; };
+
+    for (std::size_t s : strides) {
+        const std::string k = (s == 1 ? "sequential_" : "strided_") + t + "_s" + std::to_string(s);
+
+        auto rr = vs::bench(k + "_rt", 2, iters, [&] {
+            runtime_stride = s;
+            sink(vs::kv::strided_rt(data.data(), n, runtime_stride));
+        });
+        vs::print_csv_row(std::cout, rr);
+
+        auto rs = vs::bench(k + spec(s), 2, iters, [&] {
+            sink(vs::kv::strided(data.data(), n, s));
+        });
+        vs::print_csv_row(std::cout, rs);
+    }
+
+    for (std::size_t s : strides) {
+        const std::string k = "gather_" + t + "_s" + std::to_string(s);
+
+        auto rr = vs::bench(k + "_rt", 2, iters, [&] {
+            runtime_stride = s;
+            sink(vs::kv::gather_rt(data.data(), idx.data(), n_idx, runtime_stride));
+        });
+        vs::print_csv_row(std::cout, rr);
+
+        auto rs = vs::bench(k + spec(s), 2, iters, [&] {
+            sink(vs::kv::gather(data.data(), idx.data(), n_idx, s));
+        });
+        vs::print_csv_row(std::cout, rs);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t bytes = 64u << 20;
+    std::size_t iters = 10;
+    std::size_t stride = 16;    // in elements, as in vs_mem_access; >64 exercises the fallback
+    std::uint64_t seed = 12345;
+
+    if (argc > 1) bytes = std::stoull(argv[1]);
+    if (argc > 2) iters = std::stoull(argv[2]);
+    if (argc > 3) stride = std::stoull(argv[3]);
+    if (argc > 4) seed = std::stoull(argv[4]);
+    if (stride == 0) stride = 1;
+    if (bytes < sizeof(double)) {
+        // Every type needs at least one element (gather indices are taken mod n).
+        std::cerr << "usage: " << argv[0] << " [bytes >= " << sizeof(double)
+                  << "] [iters] [stride] [seed] [--out dir]\n";
+        return 1;
+    }
+
+    std::string out_dir;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--out" && i + 1 < argc) out_dir = argv[++i];
+    }
+    if (!out_dir.empty()) std::filesystem::create_directories(out_dir);
+
+    std::vector<std::size_t> strides = {1, 2, 4, 8, 16, 64};
+    if (std::find(strides.begin(), strides.end(), stride) == strides.end()) strides.push_back(stride);
+
+    std::cout << "specialized_kernels_bench bytes=" << bytes << " iters=" << iters << " stride=" << stride << "\n";
+    vs::print_csv_header(std::cout);
+
+    run_type<std::uint8_t>(bytes, iters, strides, seed);
+    run_type<std::uint16_t>(bytes, iters, strides, seed);
+    run_type<std::uint32_t>(bytes, iters, strides, seed);
+    run_type<std::uint64_t>(bytes, iters, strides, seed);
+    run_type<float>(bytes, iters, strides, seed);
+    run_type<double>(bytes, iters, strides, seed);
+
+    std::cerr << "usink=" << usink << " fsink=" << fsink << "\n";
+
+    vs::trace::flush_to_dir(out_dir);
+    return 0;
+}
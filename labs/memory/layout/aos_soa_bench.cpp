@@ -2,12 +2,15 @@
 #include <vector>
 #include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <string>
 #ifdef _WIN32
 #include "metrics_win.hpp"
 #endif
 
 
 #include "bench.hpp"
+#include "roofline.hpp"
 
 namespace {
 
@@ -35,170 +38,114 @@ int main(int argc, char** argv) {
     if (argc > 2) iters = std::stoull(argv[2]);
 	
 	std::string out_dir;
+	bool roofline = false;
 	for (int i = 1; i < argc; ++i) {
 		std::string a = argv[i];
 		if (a == "--out" && i + 1 < argc) out_dir = argv[++i];
+		if (a == "--roofline") roofline = true;
 	}
 	if (!out_dir.empty()) std::filesystem::create_directories(out_dir);
 
     std::vector<ParticleAoS> aos(N);
     ParticlesSoA soa(N);
 	
-	vs::RunMetadata base{};
-	base.suite = "memory.layout";
-	base.build_type =
-	#if defined(NDEBUG)
-		"Release";
-	#else
-		"DebugOrRelWithDebInfo";
-	#endif
-
-	base.compiler =
-	#if defined(_MSC_VER)
-		"MSVC " + std::to_string(_MSC_VER);
-	#else
-		"UnknownCompiler";
-	#endif
-	base.timestamp_utc = vs::utc_timestamp();
-	base.git_commit = vs::get_env("GITHUB_SHA");
-	#ifdef _WIN32
-	base.sys = vs::get_system_info();
-	#endif
+    const vs::RunMetadata base = vs::make_run_metadata("memory.layout");
 
 
     // init
-    for (std::size_t i = 0; i < N; ++i) {
-        const float f = (float)(i % 1024) * 0.001f;
-        aos[i] = ParticleAoS{f, f + 1.0f, f + 2.0f, (std::uint8_t)(i & 1)};
-        soa.x[i] = f; soa.y[i] = f + 1.0f; soa.z[i] = f + 2.0f; soa.active[i] = (std::uint8_t)(i & 1);
+    {
+        VS_ZONE("init_particles");
+        for (std::size_t i = 0; i < N; ++i) {
+            const float f = (float)(i % 1024) * 0.001f;
+            aos[i] = ParticleAoS{f, f + 1.0f, f + 2.0f, (std::uint8_t)(i & 1)};
+            soa.x[i] = f; soa.y[i] = f + 1.0f; soa.z[i] = f + 2.0f; soa.active[i] = (std::uint8_t)(i & 1);
+        }
     }
 
     std::cout << "aos_soa_bench N=" << N << " iters=" << iters << "\n";
-    vs::print_csv_header(std::cout);
 
-    // Iterate positions only: SoA often wins due to tighter contiguous arrays
-    {
-        #ifdef _WIN32
-		{
-			vs::WinCounters c{};
-			auto r = vs::bench_with_counters("AoS_iterate_positions_only", 5, iters, [&] {
-				float acc = 0.0f;
-				for (std::size_t i = 0; i < N; ++i) acc += aos[i].x + aos[i].y + aos[i].z;
-				fsink += acc;
-			}, c);
-			vs::print_csv_row(std::cout, r);
-
-			if (!out_dir.empty()) {
-				auto meta = base;
-				meta.benchmark = r.name;
-				meta.counters = c;
-				vs::write_json_result((std::filesystem::path(out_dir) / "AoS_iterate_positions_only.json").string(), meta, r);
-			}
-		}
-		#else
-			auto r = vs::bench("AoS_iterate_positions_only", 5, iters, [&] {
-				float acc = 0.0f;
-				for (std::size_t i = 0; i < N; ++i) {
-					acc += aos[i].x + aos[i].y + aos[i].z;
-				}
-				fsink += acc;
-			});
-			vs::print_csv_row(std::cout, r);
-		#endif
+    vs::MachinePeaks peaks{};
+    std::vector<vs::RooflinePoint> points;
+    if (roofline) {
+        peaks = vs::measure_peaks();
+        vs::print_peaks(std::cout, peaks);
     }
 
-    {
-		#ifdef _WIN32
-		{
-			vs::WinCounters c{};
-			auto r = vs::bench_with_counters("AoS_iterate_positions_only", 5, iters, [&] {
-				float acc = 0.0f;
-				for (std::size_t i = 0; i < N; ++i) acc += aos[i].x + aos[i].y + aos[i].z;
-				fsink += acc;
-			}, c);
-			vs::print_csv_row(std::cout, r);
-
-			if (!out_dir.empty()) {
-				auto meta = base;
-				meta.benchmark = r.name;
-				meta.counters = c;
-				vs::write_json_result((std::filesystem::path(out_dir) / "AoS_iterate_positions_only.json").string(), meta, r);
-			}
-		}
-		#else
-        auto r = vs::bench("SoA_iterate_positions_only", 5, iters, [&] {
-            float acc = 0.0f;
-            for (std::size_t i = 0; i < N; ++i) {
-                acc += soa.x[i] + soa.y[i] + soa.z[i];
-            }
-            fsink += acc;
-        });
-        vs::print_csv_row(std::cout, r);
-		#endif
-    }
+    vs::print_csv_header(std::cout);
 
-    // Iterate positions + active flag (more mixed access)
-    {
-		#ifdef _WIN32
-		{
-			vs::WinCounters c{};
-			auto r = vs::bench_with_counters("AoS_iterate_positions_only", 5, iters, [&] {
-				float acc = 0.0f;
-				for (std::size_t i = 0; i < N; ++i) acc += aos[i].x + aos[i].y + aos[i].z;
-				fsink += acc;
-			}, c);
-			vs::print_csv_row(std::cout, r);
-
-			if (!out_dir.empty()) {
-				auto meta = base;
-				meta.benchmark = r.name;
-				meta.counters = c;
-				vs::write_json_result((std::filesystem::path(out_dir) / "AoS_iterate_positions_only.json").string(), meta, r);
-			}
-		}
-		#else
-        auto r = vs::bench("AoS_iterate_with_active_branch", 5, iters, [&] {
-            float acc = 0.0f;
-            for (std::size_t i = 0; i < N; ++i) {
-                if (aos[i].active) acc += aos[i].x;
-            }
-            fsink += acc;
-        });
+    // One place for timing, CSV, per-benchmark JSON and the roofline point.
+    auto run_case = [&](const std::string& name, const vs::KernelWork& work, const std::function<void()>& fn) {
+#ifdef _WIN32
+        vs::WinCounters c{};
+        auto r = vs::bench_with_counters(name, 5, iters, fn, c);
+#else
+        auto r = vs::bench(name, 5, iters, fn);
+#endif
         vs::print_csv_row(std::cout, r);
-		#endif
-    }
 
-    {
-		#ifdef _WIN32
-		{
-			vs::WinCounters c{};
-			auto r = vs::bench_with_counters("AoS_iterate_positions_only", 5, iters, [&] {
-				float acc = 0.0f;
-				for (std::size_t i = 0; i < N; ++i) acc += aos[i].x + aos[i].y + aos[i].z;
-				fsink += acc;
-			}, c);
-			vs::print_csv_row(std::cout, r);
-
-			if (!out_dir.empty()) {
-				auto meta = base;
-				meta.benchmark = r.name;
-				meta.counters = c;
-				vs::write_json_result((std::filesystem::path(out_dir) / "AoS_iterate_positions_only.json").string(), meta, r);
-			}
-		}
-		#else
-        auto r = vs::bench("SoA_iterate_with_active_branch", 5, iters, [&] {
-            float acc = 0.0f;
-            for (std::size_t i = 0; i < N; ++i) {
-                if (soa.active[i]) acc += soa.x[i];
-            }
-            fsink += acc;
-        });
-        vs::print_csv_row(std::cout, r);
-		#endif
+        if (!out_dir.empty()) {
+            auto meta = base;
+            meta.benchmark = r.name;
+#ifdef _WIN32
+            meta.counters = c;
+#endif
+            vs::write_json_result((std::filesystem::path(out_dir) / (name + ".json")).string(), meta, r);
+        }
+        if (roofline) points.push_back(vs::roofline_point(r, work, peaks));
+    };
+
+    // Positions-only reads 12 useful bytes, but AoS drags the whole padded
+    // struct through the cache; SoA reads exactly the three float arrays, and
+    // its branch variant only x and active.
+    const std::size_t aos_bytes = N * sizeof(ParticleAoS);
+    const std::size_t soa_pos_bytes = N * 3 * sizeof(float);
+    const std::size_t soa_x_active_bytes = N * (sizeof(float) + sizeof(std::uint8_t));
+
+    // Iterate positions only: SoA often wins due to tighter contiguous arrays
+    run_case("AoS_iterate_positions_only", {N, (double)sizeof(ParticleAoS), 3.0, aos_bytes, sizeof(float)}, [&] {
+        float acc = 0.0f;
+        for (std::size_t i = 0; i < N; ++i) {
+            acc += aos[i].x + aos[i].y + aos[i].z;
+        }
+        fsink += acc;
+    });
+
+    run_case("SoA_iterate_positions_only", {N, 3.0 * sizeof(float), 3.0, soa_pos_bytes, sizeof(float)}, [&] {
+        float acc = 0.0f;
+        for (std::size_t i = 0; i < N; ++i) {
+            acc += soa.x[i] + soa.y[i] + soa.z[i];
+        }
+        fsink += acc;
+    });
+
+    // Iterate positions + active flag (more mixed access)
+    // Half the elements are active, so 0.5 flops/element on average.
+    run_case("AoS_iterate_with_active_branch", {N, (double)sizeof(ParticleAoS), 0.5, aos_bytes, sizeof(float)}, [&] {
+        float acc = 0.0f;
+        for (std::size_t i = 0; i < N; ++i) {
+            if (aos[i].active) acc += aos[i].x;
+        }
+        fsink += acc;
+    });
+
+    run_case("SoA_iterate_with_active_branch", {N, sizeof(std::uint8_t) + sizeof(float), 0.5, soa_x_active_bytes, sizeof(float)}, [&] {
+        float acc = 0.0f;
+        for (std::size_t i = 0; i < N; ++i) {
+            if (soa.active[i]) acc += soa.x[i];
+        }
+        fsink += acc;
+    });
+
+    if (roofline) {
+        std::cout << "\n";
+        vs::print_roofline(std::cout, points);
+        if (!out_dir.empty())
+            vs::write_json_roofline((std::filesystem::path(out_dir) / "roofline.json").string(), base, peaks, points);
     }
 
     std::cerr << "fsink=" << fsink << "\n";
+
+    vs::trace::flush_to_dir(out_dir);
 	
     return 0;
 }
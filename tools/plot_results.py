@@ -19,6 +19,8 @@ def load_json_folder(folder):
     for p in Path(folder).glob("*.json"):
         with open(p, "r", encoding="utf-8") as f:
             j = json.load(f)
+        if "benchmark" not in j:
+            continue  # trace.json / roofline.json share the --out folder
         r = {
             "name": j["benchmark"],
             "mean_ns": j["result"]["mean_ns"],
@@ -31,15 +33,68 @@ def load_json_folder(folder):
         rows.append(r)
     return rows
 
+def plot_roofline(path, title):
+    with open(path, "r", encoding="utf-8") as f:
+        j = json.load(f)
+    peaks = j["peaks"]
+    kernels = j["kernels"]
+
+    fig, (ax, bx) = plt.subplots(1, 2, figsize=(13, 5))
+
+    # Left: classic roofline for kernels that do arithmetic.
+    xs = [2.0 ** e for e in range(-8, 7)]
+    for b in peaks["bandwidth"]:
+        ax.plot(xs, [min(peaks["simd_gflops"], b["gbps"] * x) for x in xs],
+                label=f'{b["level"]} {b["gbps"]:.1f} GB/s')
+    ax.axhline(peaks["scalar_gflops"], linestyle="--", color="gray",
+               label=f'scalar {peaks["scalar_gflops"]:.1f} GFLOP/s')
+    ax.axhline(peaks["simd_gflops"], linestyle=":", color="black",
+               label=f'{peaks["simd_isa"]} f64 {peaks["simd_gflops"]:.1f} GFLOP/s')
+    if any(k.get("fp_bytes") == 4 for k in kernels):
+        ax.axhline(2 * peaks["simd_gflops"], linestyle="-.", color="black",
+                   label=f'{peaks["simd_isa"]} f32 {2 * peaks["simd_gflops"]:.1f} GFLOP/s')
+    for k in kernels:
+        if k["intensity"] > 0:
+            failed = k.get("calibration") == "failed"
+            ax.plot(k["intensity"], k["gflops"], "x" if failed else "o")
+            ax.annotate(f'{k["name"]} ({k["pct_of_roof"]:.0f}%{", above roof" if failed else ""})',
+                        (k["intensity"], k["gflops"]), fontsize=8,
+                        xytext=(4, 4), textcoords="offset points")
+    ax.set_xscale("log", base=2)
+    ax.set_yscale("log")
+    ax.set_xlabel("Arithmetic intensity (flop/byte)")
+    ax.set_ylabel("GFLOP/s")
+    ax.legend(fontsize=8)
+
+    # Right: achieved bandwidth against the roof read off the bandwidth curve
+    # at each kernel's footprint.
+    names = [k["name"] for k in kernels]
+    bx.bar(names, [k["gbps"] for k in kernels], label="achieved")
+    bx.scatter(names, [k["roof_gbps"] for k in kernels], marker="_", s=600,
+               color="red", label="roof at footprint")
+    bx.set_xticks(range(len(names)))
+    bx.set_xticklabels(names, rotation=25, ha="right")
+    bx.set_ylabel("GB/s")
+    bx.legend(fontsize=8)
+
+    fig.suptitle(title)
+    fig.tight_layout()
+    plt.show()
+
 def main():
     ap = argparse.ArgumentParser()
     ap.add_argument("--csv", help="CSV file from stdout redirection")
     ap.add_argument("--jsondir", help="Folder of per-benchmark JSON files")
+    ap.add_argument("--roofline", help="roofline.json written by a lab run with --roofline --out")
     ap.add_argument("--title", default="Visible Systems Memory Lab Results")
     args = ap.parse_args()
 
+    if args.roofline:
+        plot_roofline(args.roofline, args.title)
+        return
+
     if not args.csv and not args.jsondir:
-        raise SystemExit("Provide --csv or --jsondir")
+        raise SystemExit("Provide --csv, --jsondir or --roofline")
 
     if args.csv:
         rows = load_csv(args.csv)